@@ -0,0 +1,206 @@
+#include "allocation_bitmap.h"
+#include <algorithm>
+#include <bitset>
+#include <filesystem>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace {
+    constexpr uint64_t all_ones = ~static_cast<uint64_t>(0);
+    constexpr size_t no_run = static_cast<size_t>(-1);
+    
+    // value must be non-zero
+    size_t countTrailingZeros(uint64_t value) {
+#if defined(_MSC_VER)
+        unsigned long index;
+        _BitScanForward64(&index, value);
+        return static_cast<size_t>(index);
+#else
+        return static_cast<size_t>(__builtin_ctzll(value));
+#endif
+    }
+    
+    size_t countSetBits(uint64_t value) {
+        return std::bitset<64>(value).count();
+    }
+}
+
+AllocationBitmap::AllocationBitmap(const std::string& filename, size_t total_blocks)
+    : bitmap_file_name(filename)
+    , total_blocks(total_blocks)
+    , words((total_blocks + bits_per_word - 1) / bits_per_word, 0) {
+}
+
+bool AllocationBitmap::load(bool disk_exists) {
+    size_t bitmap_bytes = words.size() * sizeof(uint64_t);
+    std::error_code ec;
+    bool file_valid = disk_exists
+                      && std::filesystem::exists(bitmap_file_name, ec)
+                      && std::filesystem::file_size(bitmap_file_name, ec) == bitmap_bytes;
+    
+    if (file_valid) {
+        std::ifstream read_file(bitmap_file_name, std::ios::binary);
+        read_file.read(reinterpret_cast<char*>(words.data()), static_cast<std::streamsize>(bitmap_bytes));
+        if (read_file.fail()) {
+            return false;
+        }
+    } else {
+        std::fill(words.begin(), words.end(), disk_exists ? all_ones : 0);
+    }
+    
+    // Padding bits past the last block stay allocated so scans never hand them out
+    size_t tail_bits = total_blocks % bits_per_word;
+    if (tail_bits != 0) {
+        words.back() |= all_ones << tail_bits;
+    }
+    
+    allocated_blocks = 0;
+    for (uint64_t word : words) {
+        allocated_blocks += countSetBits(word);
+    }
+    allocated_blocks -= words.size() * bits_per_word - total_blocks;
+    
+    if (!file_valid) {
+        std::ofstream create_file(bitmap_file_name, std::ios::binary | std::ios::trunc);
+        create_file.write(reinterpret_cast<const char*>(words.data()), static_cast<std::streamsize>(bitmap_bytes));
+        if (create_file.fail()) {
+            return false;
+        }
+    }
+    
+    bitmap_file = std::make_unique<std::fstream>(bitmap_file_name, std::ios::in | std::ios::out | std::ios::binary);
+    return bitmap_file->is_open();
+}
+
+bool AllocationBitmap::isAllocated(size_t block) const {
+    return (words[block / bits_per_word] >> (block % bits_per_word)) & 1;
+}
+
+bool AllocationBitmap::anyAllocated(size_t first, size_t count) const {
+    for (size_t block = first; block < first + count; ++block) {
+        if (isAllocated(block)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+int AllocationBitmap::allocate(size_t count) {
+    if (count == 0 || count > total_blocks - allocated_blocks) {
+        return -1;
+    }
+    
+    size_t first = findFreeRun(count);
+    if (first == no_run || !markAllocated(first, count)) {
+        return -1;
+    }
+    
+    return static_cast<int>(first);
+}
+
+bool AllocationBitmap::markAllocated(size_t first, size_t count) {
+    if (count == 0 || first >= total_blocks || count > total_blocks - first) {
+        return false;
+    }
+    
+    setRange(first, count, true);
+    return persistRange(first, count);
+}
+
+bool AllocationBitmap::markFree(size_t first, size_t count) {
+    if (count == 0 || first >= total_blocks || count > total_blocks - first) {
+        return false;
+    }
+    
+    setRange(first, count, false);
+    return persistRange(first, count);
+}
+
+size_t AllocationBitmap::findFreeRun(size_t count) const {
+    size_t run_start = 0;
+    size_t run_length = 0;
+    
+    for (size_t w = 0; w < words.size(); ++w) {
+        uint64_t word = words[w];
+        
+        // Whole-word fast paths: fully used words break the run, empty ones extend it by 64
+        if (word == all_ones) {
+            run_length = 0;
+            continue;
+        }
+        if (word == 0) {
+            if (run_length == 0) {
+                run_start = w * bits_per_word;
+            }
+            run_length += bits_per_word;
+            if (run_length >= count) {
+                return run_start;
+            }
+            continue;
+        }
+        
+        // Mixed word: hop between free and used stretches with trailing-zero counts
+        size_t bit = 0;
+        while (bit < bits_per_word) {
+            uint64_t rest = word >> bit;
+            if ((rest & 1) == 0) {
+                size_t free_bits = rest == 0 ? bits_per_word - bit : countTrailingZeros(rest);
+                if (run_length == 0) {
+                    run_start = w * bits_per_word + bit;
+                }
+                run_length += free_bits;
+                if (run_length >= count) {
+                    return run_start;
+                }
+                bit += free_bits;
+            } else {
+                run_length = 0;
+                bit += countTrailingZeros(~rest);
+            }
+        }
+    }
+    
+    return no_run;
+}
+
+void AllocationBitmap::setRange(size_t first, size_t count, bool allocated) {
+    size_t block = first;
+    size_t end = first + count;
+    
+    while (block < end) {
+        size_t w = block / bits_per_word;
+        size_t bit = block % bits_per_word;
+        size_t span = std::min(bits_per_word - bit, end - block);
+        uint64_t mask = (span == bits_per_word ? all_ones : ((static_cast<uint64_t>(1) << span) - 1)) << bit;
+        
+        uint64_t before = words[w];
+        words[w] = allocated ? (before | mask) : (before & ~mask);
+        
+        size_t changed = countSetBits(before ^ words[w]);
+        if (allocated) {
+            allocated_blocks += changed;
+        } else {
+            allocated_blocks -= changed;
+        }
+        
+        block += span;
+    }
+}
+
+bool AllocationBitmap::persistRange(size_t first, size_t count) {
+    size_t first_word = first / bits_per_word;
+    size_t last_word = (first + count - 1) / bits_per_word;
+    
+    bitmap_file->seekp(static_cast<std::streamoff>(first_word * sizeof(uint64_t)));
+    bitmap_file->write(reinterpret_cast<const char*>(&words[first_word]),
+                       static_cast<std::streamsize>((last_word - first_word + 1) * sizeof(uint64_t)));
+    if (bitmap_file->fail()) {
+        bitmap_file->clear();
+        return false;
+    }
+    
+    bitmap_file->flush();
+    return true;
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+// One bit per block (set = allocated), persisted to a sidecar file next to the disk.
+class AllocationBitmap {
+private:
+    static constexpr size_t bits_per_word = 64;
+    
+    std::string bitmap_file_name;
+    size_t total_blocks;
+    std::vector<uint64_t> words;  // Padding bits past total_blocks are kept set
+    size_t allocated_blocks = 0;
+    std::unique_ptr<std::fstream> bitmap_file;
+    
+    size_t findFreeRun(size_t count) const;
+    void setRange(size_t first, size_t count, bool allocated);
+    bool persistRange(size_t first, size_t count);
+
+public:
+    AllocationBitmap(const std::string& filename, size_t total_blocks);
+    
+    // Open the bitmap file for an existing disk, rebuilding it as fully allocated if it is
+    // missing or the wrong size (usage unknown). A new disk always starts from an all-free
+    // bitmap, overwriting any sidecar left behind by a previous disk.
+    bool load(bool disk_exists);
+    
+    bool isAllocated(size_t block) const;
+    bool anyAllocated(size_t first, size_t count) const;
+    
+    // First-fit contiguous extent; returns the first block or -1 when no run is large enough
+    int allocate(size_t count);
+    bool markAllocated(size_t first, size_t count);
+    bool markFree(size_t first, size_t count);
+    
+    size_t getAllocatedBlocks() const { return allocated_blocks; }
+    size_t getFreeBlocks() const { return total_blocks - allocated_blocks; }
+};
@@ -1,5 +1,22 @@
 #include "block_cache.h"
+#include "storage_engine.h"
 #include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+namespace {
+    constexpr uint32_t snapshot_magic = 0x50414E53;  // "SNAP"
+    constexpr uint32_t snapshot_version = 1;
+    constexpr uint32_t snapshot_flag_data = 0x1;
+    
+    // Warm-up reads coalesce nearby keys into one sequential request,
+    // reading through gaps of up to max_prefetch_gap unused blocks.
+    constexpr size_t max_prefetch_run = 64;
+    constexpr int max_prefetch_gap = 8;
+}
 
 BlockCache::BlockCache(size_t max_blocks) : max_blocks(max_blocks) {
 }
@@ -15,6 +32,9 @@ std::string BlockCache::get(int block_number) {
         recent_blocks.splice(recent_blocks.begin(), recent_blocks, list_it);
         
         stats.hits++;
+        if (warmed_keys.erase(block_number) > 0) {
+            stats.warm_hits++;
+        }
         return data;
     }
     
@@ -25,10 +45,15 @@ std::string BlockCache::get(int block_number) {
 void BlockCache::put(int block_number, const char* data) {
     std::lock_guard<std::mutex> lock(cache_lock);
     
+    warmed_keys.erase(block_number);
+    insertLocked(block_number, data);
+}
+
+void BlockCache::insertLocked(int block_number, std::string data) {
     auto it = block_map.find(block_number);
     if (it != block_map.end()) {
         auto list_it = it->second;
-        list_it->second = data;
+        list_it->second = std::move(data);
         
         recent_blocks.splice(recent_blocks.begin(), recent_blocks, list_it);
     } else {
@@ -36,7 +61,7 @@ void BlockCache::put(int block_number, const char* data) {
             removeOldest();
         }
         
-        recent_blocks.emplace_front(block_number, data);
+        recent_blocks.emplace_front(block_number, std::move(data));
         block_map[block_number] = recent_blocks.begin();
         stats.cached_blocks = recent_blocks.size();
     }
@@ -49,6 +74,7 @@ void BlockCache::remove(int block_number) {
     if (it != block_map.end()) {
         recent_blocks.erase(it->second);
         block_map.erase(it);
+        warmed_keys.erase(block_number);
         stats.cached_blocks = recent_blocks.size();
     }
 }
@@ -58,9 +84,166 @@ void BlockCache::clear() {
     
     recent_blocks.clear();
     block_map.clear();
+    warmed_keys.clear();
     stats.cached_blocks = 0;
 }
 
+bool BlockCache::saveSnapshot(const std::string& filename, bool include_data) const {
+    std::vector<std::pair<int, std::string>> entries;
+    {
+        std::lock_guard<std::mutex> lock(cache_lock);
+        entries.reserve(recent_blocks.size());
+        // Oldest first, so a reload that inserts in file order rebuilds the same recency
+        for (auto it = recent_blocks.rbegin(); it != recent_blocks.rend(); ++it) {
+            entries.emplace_back(it->first, include_data ? it->second : std::string());
+        }
+    }
+    
+    std::string temp_name = filename + ".tmp";
+    std::ofstream out(temp_name, std::ios::binary | std::ios::trunc);
+    if (!out.is_open()) {
+        return false;
+    }
+    
+    uint32_t flags = include_data ? snapshot_flag_data : 0;
+    uint64_t count = entries.size();
+    out.write(reinterpret_cast<const char*>(&snapshot_magic), sizeof(snapshot_magic));
+    out.write(reinterpret_cast<const char*>(&snapshot_version), sizeof(snapshot_version));
+    out.write(reinterpret_cast<const char*>(&flags), sizeof(flags));
+    out.write(reinterpret_cast<const char*>(&count), sizeof(count));
+    
+    for (const auto& entry : entries) {
+        int32_t block_number = entry.first;
+        out.write(reinterpret_cast<const char*>(&block_number), sizeof(block_number));
+        if (include_data) {
+            uint32_t length = static_cast<uint32_t>(entry.second.size());
+            out.write(reinterpret_cast<const char*>(&length), sizeof(length));
+            out.write(entry.second.data(), length);
+        }
+    }
+    
+    out.close();
+    if (out.fail()) {
+        return false;
+    }
+    
+    std::error_code ec;
+    std::filesystem::rename(temp_name, filename, ec);
+    return !ec;
+}
+
+size_t BlockCache::warmFromSnapshot(const std::string& filename, StorageEngine& disk) {
+    auto start = std::chrono::steady_clock::now();
+    
+    std::ifstream in(filename, std::ios::binary);
+    if (!in.is_open()) {
+        return 0;
+    }
+    
+    uint32_t magic = 0;
+    uint32_t version = 0;
+    uint32_t flags = 0;
+    uint64_t count = 0;
+    in.read(reinterpret_cast<char*>(&magic), sizeof(magic));
+    in.read(reinterpret_cast<char*>(&version), sizeof(version));
+    in.read(reinterpret_cast<char*>(&flags), sizeof(flags));
+    in.read(reinterpret_cast<char*>(&count), sizeof(count));
+    if (in.fail() || magic != snapshot_magic || version != snapshot_version) {
+        return 0;
+    }
+    
+    bool has_data = (flags & snapshot_flag_data) != 0;
+    std::vector<std::pair<int, std::string>> entries;
+    entries.reserve(static_cast<size_t>(std::min<uint64_t>(count, max_blocks)));
+    
+    for (uint64_t i = 0; i < count; ++i) {
+        int32_t block_number = 0;
+        in.read(reinterpret_cast<char*>(&block_number), sizeof(block_number));
+        std::string data;
+        if (has_data) {
+            uint32_t length = 0;
+            in.read(reinterpret_cast<char*>(&length), sizeof(length));
+            if (in.fail() || length > disk.getBlockSize()) {
+                return 0;
+            }
+            data.resize(length);
+            in.read(&data[0], length);
+        }
+        if (in.fail()) {
+            return 0;
+        }
+        if (disk.isValidBlock(block_number)) {
+            entries.emplace_back(block_number, std::move(data));
+        }
+    }
+    
+    // Only the most recent max_blocks entries can survive insertion
+    if (entries.size() > max_blocks) {
+        entries.erase(entries.begin(), entries.end() - static_cast<std::ptrdiff_t>(max_blocks));
+    }
+    
+    if (!has_data) {
+        std::vector<int> keys;
+        keys.reserve(entries.size());
+        for (const auto& entry : entries) {
+            keys.push_back(entry.first);
+        }
+        std::sort(keys.begin(), keys.end());
+        keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+        
+        size_t block_size = disk.getBlockSize();
+        std::unordered_map<int, std::string> contents;
+        std::vector<char> run_buffer;
+        
+        size_t i = 0;
+        while (i < keys.size()) {
+            size_t j = i + 1;
+            while (j < keys.size()
+                   && keys[j] - keys[j - 1] <= max_prefetch_gap
+                   && static_cast<size_t>(keys[j] - keys[i]) < max_prefetch_run) {
+                ++j;
+            }
+            
+            size_t run_length = static_cast<size_t>(keys[j - 1] - keys[i]) + 1;
+            run_buffer.resize(run_length * block_size);
+            if (disk.readBlocks(keys[i], run_length, run_buffer.data())) {
+                for (size_t k = i; k < j; ++k) {
+                    size_t offset = static_cast<size_t>(keys[k] - keys[i]) * block_size;
+                    contents[keys[k]] = std::string(run_buffer.data() + offset);
+                }
+            }
+            i = j;
+        }
+        
+        for (auto& entry : entries) {
+            auto it = contents.find(entry.first);
+            if (it != contents.end()) {
+                entry.second = it->second;
+            }
+        }
+    }
+    
+    size_t restored = 0;
+    {
+        std::lock_guard<std::mutex> lock(cache_lock);
+        for (auto& entry : entries) {
+            // Empty blocks would only occupy a slot and read back as a miss
+            if (entry.second.empty()) {
+                continue;
+            }
+            insertLocked(entry.first, std::move(entry.second));
+            warmed_keys.insert(entry.first);
+            restored++;
+        }
+        
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        stats.warmed_blocks = restored;
+        stats.warm_time_ms = std::chrono::duration<double, std::milli>(elapsed).count();
+    }
+    
+    return restored;
+}
+
 CacheStats BlockCache::getStats() const {
     std::lock_guard<std::mutex> lock(cache_lock);
     return stats;
@@ -80,6 +263,7 @@ void BlockCache::removeOldest() {
     if (!recent_blocks.empty()) {
         auto last = recent_blocks.back();
         block_map.erase(last.first);
+        warmed_keys.erase(last.first);
         recent_blocks.pop_back();
         stats.cached_blocks = recent_blocks.size();
     }
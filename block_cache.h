@@ -1,15 +1,24 @@
 #pragma once
 
 #include <unordered_map>
+#include <unordered_set>
 #include <list>
 #include <string>
 #include <mutex>
 
+class StorageEngine;
+
 struct CacheStats {
     size_t hits = 0;
     size_t misses = 0;
     size_t cached_blocks = 0;
     
+    // Warm restart: blocks restored from a snapshot, how long it took,
+    // and how many of them have since served a hit.
+    size_t warmed_blocks = 0;
+    size_t warm_hits = 0;
+    double warm_time_ms = 0.0;
+    
     double getHitRatio() const {
         size_t total = hits + misses;
         return total > 0 ? (static_cast<double>(hits) / total) * 100.0 : 0.0;
@@ -21,6 +30,7 @@ private:
     size_t max_blocks;
     std::list<std::pair<int, std::string>> recent_blocks;  // Most recent at front
     std::unordered_map<int, std::list<std::pair<int, std::string>>::iterator> block_map;
+    std::unordered_set<int> warmed_keys;  // Restored blocks not yet hit
     mutable std::mutex cache_lock;
     
     CacheStats stats;
@@ -33,10 +43,18 @@ public:
     void remove(int block_number);
     void clear();
     
+    // Snapshot the key set in recency order (optionally with block contents)
+    bool saveSnapshot(const std::string& filename, bool include_data) const;
+    // Reload a snapshot; keys without contents are prefetched from disk in sequential runs.
+    // Returns the number of blocks restored.
+    size_t warmFromSnapshot(const std::string& filename, StorageEngine& disk);
+    
     CacheStats getStats() const;
     size_t size() const;
+    size_t capacity() const { return max_blocks; }
     bool contains(int block_number) const;
     
 private:
+    void insertLocked(int block_number, std::string data);
     void removeOldest();
 };
@@ -2,20 +2,29 @@
 #include <string>
 #include <memory>
 #include <iomanip>
+#include <vector>
+#include <cstring>
 #include "storage_engine.h"
 #include "block_cache.h"
 #include "metrics.h"
 #include "utils.h"
+#include "stats_reporter.h"
 
 class StorageSimulator {
 private:
     std::unique_ptr<StorageEngine> disk;
     std::unique_ptr<BlockCache> memory_cache;
     std::unique_ptr<Metrics> stats;
+    std::unique_ptr<StatsReporter> reporter;
     
     static constexpr size_t disk_size_mb = 10;
     static constexpr size_t block_size_bytes = 4096;
     static constexpr size_t max_cached_blocks = 100;
+    static constexpr const char* cache_snapshot_file = "cache_snapshot.bin";
+    static constexpr bool snapshot_include_data = false;  // Disk is authoritative; keys are enough
+    static constexpr const char* stats_dump_file = "storage_stats.json";
+    static constexpr StatsFormat stats_dump_format = StatsFormat::Json;
+    static constexpr std::chrono::milliseconds stats_dump_interval{1000};
 
 public:
     StorageSimulator() 
@@ -25,6 +34,19 @@ public:
         
         std::cout << "Storage Simulator v1.0" << std::endl;
         std::cout << "Disk: " << disk_size_mb << "MB, Cache: " << max_cached_blocks << " blocks" << std::endl;
+        
+        if (Utils::fileExists(cache_snapshot_file)) {
+            size_t restored = memory_cache->warmFromSnapshot(cache_snapshot_file, *disk);
+            auto cache_stats = memory_cache->getStats();
+            std::cout << "Warm restart: " << restored << " blocks in " << std::fixed << std::setprecision(1)
+                      << cache_stats.warm_time_ms << "ms" << std::endl;
+        }
+        
+        disk->setPhaseTracer(&stats->getPhaseTracer());
+        reporter = std::make_unique<StatsReporter>(*stats, *memory_cache, *disk,
+                                                   stats_dump_file, stats_dump_format, stats_dump_interval);
+        reporter->start();
+        std::cout << "Live stats: " << stats_dump_file << " (every " << stats_dump_interval.count() << "ms)" << std::endl;
     }
 
     void run() {
@@ -45,6 +67,19 @@ public:
                     showStats();
                     break;
                 case 4:
+                    saveSnapshot();
+                    break;
+                case 5:
+                    togglePhaseTracing();
+                    break;
+                case 6:
+                    writeExtent();
+                    break;
+                case 7:
+                    freeBlocks();
+                    break;
+                case 8:
+                    saveSnapshot();
                     std::cout << "Goodbye!" << std::endl;
                     return;
                 default:
@@ -58,7 +93,34 @@ private:
         std::cout << "[1] Write Block" << std::endl;
         std::cout << "[2] Read Block" << std::endl;
         std::cout << "[3] Show Stats" << std::endl;
-        std::cout << "[4] Exit" << std::endl;
+        std::cout << "[4] Save Cache Snapshot" << std::endl;
+        std::cout << "[5] Toggle Phase Tracing" << std::endl;
+        std::cout << "[6] Write Extent" << std::endl;
+        std::cout << "[7] Free Blocks" << std::endl;
+        std::cout << "[8] Exit" << std::endl;
+    }
+
+    void togglePhaseTracing() {
+        PhaseTracer& tracer = stats->getPhaseTracer();
+        tracer.setEnabled(!tracer.isEnabled());
+        std::cout << "Phase tracing " << (tracer.isEnabled() ? "on." : "off.") << std::endl;
+    }
+
+    void showPhases(const PhaseBreakdown& phases) {
+        std::cout << std::fixed << std::setprecision(3);
+        for (size_t i = 0; i < PhaseBreakdown::phase_count; ++i) {
+            std::cout << (i == 0 ? "" : ", ") << PhaseTracer::getPhaseName(static_cast<Phase>(i))
+                      << " " << phases.total_ms[i] << "ms";
+        }
+        std::cout << std::endl;
+    }
+
+    void saveSnapshot() {
+        if (memory_cache->saveSnapshot(cache_snapshot_file, snapshot_include_data)) {
+            std::cout << "Snapshot saved (" << memory_cache->size() << " blocks)." << std::endl;
+        } else {
+            std::cout << "Snapshot failed." << std::endl;
+        }
     }
 
     void writeBlock() {
@@ -82,6 +144,9 @@ private:
             user_data = user_data.substr(0, block_size_bytes);
         }
         
+        PhaseTracer& tracer = stats->getPhaseTracer();
+        tracer.beginRequest();
+        
         auto start = Utils::getCurrentTime();
         bool success = disk->writeBlock(block_number, user_data.c_str());
         auto end = Utils::getCurrentTime();
@@ -90,11 +155,96 @@ private:
             memory_cache->put(block_number, user_data.c_str());
             stats->recordWrite(end - start);
             std::cout << "Written." << std::endl;
+            if (tracer.isEnabled()) {
+                showPhases(tracer.getLastRequest());
+            }
         } else {
             std::cout << "Write failed." << std::endl;
         }
     }
 
+    // Allocates a contiguous extent and fills it with one sequential write
+    void writeExtent() {
+        size_t block_count;
+        std::string user_data;
+        
+        std::cout << "Blocks: ";
+        std::cin >> block_count;
+        
+        if (block_count == 0 || block_count > disk->getTotalBlocks()) {
+            std::cout << "Invalid block count (1-" << disk->getTotalBlocks() << ")" << std::endl;
+            return;
+        }
+        
+        std::cout << "Data: ";
+        std::cin.ignore();
+        std::getline(std::cin, user_data);
+        
+        if (user_data.length() >= block_size_bytes) {
+            user_data = user_data.substr(0, block_size_bytes - 1);
+        }
+        
+        int first_block = disk->allocate(block_count);
+        if (first_block < 0) {
+            std::cout << "No free extent of " << block_count << " blocks." << std::endl;
+            return;
+        }
+        
+        std::vector<char> buffer(block_count * block_size_bytes, 0);
+        for (size_t i = 0; i < block_count; ++i) {
+            std::memcpy(buffer.data() + i * block_size_bytes, user_data.data(), user_data.length());
+        }
+        
+        PhaseTracer& tracer = stats->getPhaseTracer();
+        tracer.beginRequest();
+        
+        auto start = Utils::getCurrentTime();
+        bool success = disk->writeBlocks(first_block, block_count, buffer.data());
+        auto end = Utils::getCurrentTime();
+        
+        if (success) {
+            for (size_t i = 0; i < block_count; ++i) {
+                memory_cache->put(first_block + static_cast<int>(i), user_data.c_str());
+            }
+            stats->recordWrite(end - start);
+            std::cout << "Written to blocks " << first_block << "-"
+                      << (first_block + static_cast<int>(block_count) - 1) << "." << std::endl;
+            if (tracer.isEnabled()) {
+                showPhases(tracer.getLastRequest());
+            }
+        } else {
+            disk->free(first_block, block_count);
+            std::cout << "Write failed." << std::endl;
+        }
+    }
+
+    void freeBlocks() {
+        int block_number;
+        size_t block_count;
+        
+        std::cout << "Block ID: ";
+        std::cin >> block_number;
+        
+        if (!disk->isValidBlock(block_number)) {
+            std::cout << "Invalid block ID (0-" << (disk->getTotalBlocks() - 1) << ")" << std::endl;
+            return;
+        }
+        
+        std::cout << "Blocks: ";
+        std::cin >> block_count;
+        
+        if (!disk->free(block_number, block_count)) {
+            std::cout << "Free failed." << std::endl;
+            return;
+        }
+        
+        // Freed blocks read back as zeros, so cached copies must go too
+        for (size_t i = 0; i < block_count; ++i) {
+            memory_cache->remove(block_number + static_cast<int>(i));
+        }
+        std::cout << "Freed." << std::endl;
+    }
+
     void readBlock() {
         int block_number;
         
@@ -107,14 +257,24 @@ private:
             return;
         }
         
+        PhaseTracer& tracer = stats->getPhaseTracer();
+        tracer.beginRequest();
+        
         auto start = Utils::getCurrentTime();
         
         // Try cache first
-        std::string cached_data = memory_cache->get(block_number);
+        std::string cached_data;
+        {
+            PhaseTracer::Scope lookup_phase(&tracer, Phase::CacheLookup);
+            cached_data = memory_cache->get(block_number);
+        }
         if (!cached_data.empty()) {
             auto end = Utils::getCurrentTime();
             stats->recordCacheHit(end - start);
             std::cout << "Data: " << cached_data << std::endl;
+            if (tracer.isEnabled()) {
+                showPhases(tracer.getLastRequest());
+            }
             return;
         }
         
@@ -124,10 +284,21 @@ private:
         auto end = Utils::getCurrentTime();
         
         if (success) {
-            std::string data(buffer);
-            memory_cache->put(block_number, data.c_str());
+            std::string data;
+            {
+                PhaseTracer::Scope copy_phase(&tracer, Phase::Copy);
+                data = buffer;
+            }
+            {
+                // Filling the cache is cache work, not a copy
+                PhaseTracer::Scope fill_phase(&tracer, Phase::CacheLookup);
+                memory_cache->put(block_number, data.c_str());
+            }
             stats->recordCacheMiss(end - start);
             std::cout << "Data: " << data << std::endl;
+            if (tracer.isEnabled()) {
+                showPhases(tracer.getLastRequest());
+            }
         } else {
             std::cout << "Read failed." << std::endl;
         }
@@ -142,6 +313,14 @@ private:
                   << cache_stats.getHitRatio() << "%" << std::endl;
         std::cout << "Avg latency: " << std::fixed << std::setprecision(1) 
                   << performance_data.avg_latency_ms << "ms" << std::endl;
+        std::cout << "Disk: " << disk->getAllocatedBlocks() << "/" << disk->getTotalBlocks()
+                  << " blocks allocated" << std::endl;
+        
+        if (cache_stats.warmed_blocks > 0) {
+            std::cout << "Warm restart: " << cache_stats.warmed_blocks << " blocks in "
+                      << std::fixed << std::setprecision(1) << cache_stats.warm_time_ms << "ms, "
+                      << cache_stats.warm_hits << " reused" << std::endl;
+        }
         
         // Show latency improvement
         if (performance_data.cache_hits > 0 && performance_data.cache_misses > 0) {
@@ -149,6 +328,12 @@ private:
             std::cout << "Latency improvement: " << std::fixed << std::setprecision(0) 
                       << improvement << "%" << std::endl;
         }
+        
+        PhaseBreakdown phases = stats->getPhaseTracer().getTotals();
+        if (phases.getTotalMs() > 0.0) {
+            std::cout << "Phase totals: ";
+            showPhases(phases);
+        }
     }
 };
 
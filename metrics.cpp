@@ -65,6 +65,7 @@ void Metrics::reset() {
     data.cache_miss_latency_ms = 0.0;
     data.total_operations = 0;
     data.avg_latency_ms = 0.0;
+    phase_tracer.reset();
 }
 
 void Metrics::updateAverageLatency() {
@@ -73,3 +74,72 @@ void Metrics::updateAverageLatency() {
         data.avg_latency_ms = data.total_latency_ms / static_cast<double>(total_ops);
     }
 }
+
+void PhaseTracer::beginRequest() {
+    std::lock_guard<std::mutex> lock(request_mutex);
+    current_request = PhaseBreakdown();
+}
+
+void PhaseTracer::record(Phase phase, std::chrono::nanoseconds elapsed) {
+    size_t index = static_cast<size_t>(phase);
+    uint64_t ns = static_cast<uint64_t>(elapsed.count());
+    
+    total_ns[index].fetch_add(ns, std::memory_order_relaxed);
+    samples[index].fetch_add(1, std::memory_order_relaxed);
+    
+    std::lock_guard<std::mutex> lock(request_mutex);
+    current_request.total_ms[index] += static_cast<double>(ns) / 1e6;
+    current_request.samples[index]++;
+}
+
+PhaseBreakdown PhaseTracer::getLastRequest() const {
+    std::lock_guard<std::mutex> lock(request_mutex);
+    return current_request;
+}
+
+PhaseBreakdown PhaseTracer::getTotals() const {
+    PhaseBreakdown result;
+    for (size_t i = 0; i < PhaseBreakdown::phase_count; ++i) {
+        result.total_ms[i] = static_cast<double>(total_ns[i].load(std::memory_order_relaxed)) / 1e6;
+        result.samples[i] = static_cast<size_t>(samples[i].load(std::memory_order_relaxed));
+    }
+    return result;
+}
+
+void PhaseTracer::reset() {
+    for (size_t i = 0; i < PhaseBreakdown::phase_count; ++i) {
+        total_ns[i].store(0, std::memory_order_relaxed);
+        samples[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+const char* PhaseTracer::getPhaseName(Phase phase) {
+    switch (phase) {
+        case Phase::CacheLookup:
+            return "cache_lookup";
+        case Phase::LockWait:
+            return "lock_wait";
+        case Phase::DeviceLatency:
+            return "device_latency";
+        case Phase::IoSyscall:
+            return "io_syscall";
+        case Phase::Copy:
+            return "copy";
+        default:
+            return "unknown";
+    }
+}
+
+PhaseTracer::Scope::Scope(PhaseTracer* tracer, Phase phase)
+    : tracer(tracer && tracer->isEnabled() ? tracer : nullptr)
+    , phase(phase) {
+    if (this->tracer) {
+        start = std::chrono::steady_clock::now();
+    }
+}
+
+PhaseTracer::Scope::~Scope() {
+    if (tracer) {
+        tracer->record(phase, std::chrono::steady_clock::now() - start);
+    }
+}
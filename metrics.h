@@ -3,6 +3,7 @@
 #include <chrono>
 #include <atomic>
 #include <mutex>
+#include <cstdint>
 
 struct MetricsData {
     size_t total_reads = 0;
@@ -29,16 +30,83 @@ struct MetricsData {
         if (cache_hits > 0 && cache_misses > 0) {
             double avg_cache_latency = cache_hit_latency_ms / cache_hits;
             double avg_disk_latency = cache_miss_latency_ms / cache_misses;
+            if (avg_disk_latency <= 0.0) {
+                return 0.0;
+            }
             return ((avg_disk_latency - avg_cache_latency) / avg_disk_latency) * 100.0;
         }
         return 0.0;
     }
 };
 
+// Hot-path phases of a single read/write request
+enum class Phase {
+    CacheLookup,
+    LockWait,
+    DeviceLatency,
+    IoSyscall,
+    Copy,
+    Count
+};
+
+struct PhaseBreakdown {
+    static constexpr size_t phase_count = static_cast<size_t>(Phase::Count);
+    
+    double total_ms[phase_count] = {};
+    size_t samples[phase_count] = {};
+    
+    double getTotalMs() const {
+        double total = 0.0;
+        for (double ms : total_ms) {
+            total += ms;
+        }
+        return total;
+    }
+};
+
+// Optional per-phase timing. Disabled tracers skip the clock reads entirely.
+class PhaseTracer {
+private:
+    std::atomic<bool> enabled{false};
+    std::atomic<uint64_t> total_ns[PhaseBreakdown::phase_count] = {};
+    std::atomic<uint64_t> samples[PhaseBreakdown::phase_count] = {};
+    PhaseBreakdown current_request;
+    mutable std::mutex request_mutex;
+
+public:
+    void setEnabled(bool on) { enabled.store(on, std::memory_order_relaxed); }
+    bool isEnabled() const { return enabled.load(std::memory_order_relaxed); }
+    
+    // Start a new per-request breakdown; requests are traced one at a time
+    void beginRequest();
+    void record(Phase phase, std::chrono::nanoseconds elapsed);
+    
+    PhaseBreakdown getLastRequest() const;
+    PhaseBreakdown getTotals() const;
+    void reset();
+    
+    static const char* getPhaseName(Phase phase);
+    
+    // Times the enclosing block into the given phase; tracer may be null
+    class Scope {
+    private:
+        PhaseTracer* tracer;
+        Phase phase;
+        std::chrono::steady_clock::time_point start;
+    
+    public:
+        Scope(PhaseTracer* tracer, Phase phase);
+        ~Scope();
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+    };
+};
+
 class Metrics {
 private:
     MetricsData data;
     mutable std::mutex update_mutex;
+    PhaseTracer phase_tracer;
 
 public:
     Metrics() = default;
@@ -52,6 +120,9 @@ public:
     // Get current metrics
     MetricsData getMetrics() const;
     
+    PhaseTracer& getPhaseTracer() { return phase_tracer; }
+    const PhaseTracer& getPhaseTracer() const { return phase_tracer; }
+    
     // Reset metrics
     void reset();
     
@@ -0,0 +1,205 @@
+#include "stats_reporter.h"
+#include "storage_engine.h"
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+namespace {
+    // Metrics may be reset between dumps; treat a shrinking counter as a fresh start
+    size_t delta(size_t current, size_t previous) {
+        return current >= previous ? current - previous : current;
+    }
+    
+    double ratio(size_t part, size_t total) {
+        return total > 0 ? (static_cast<double>(part) / total) * 100.0 : 0.0;
+    }
+    
+    // Reads are recorded as cache hits/misses by the simulator, writes via recordWrite
+    size_t readCount(const MetricsData& data) {
+        return data.total_reads + data.cache_hits + data.cache_misses;
+    }
+}
+
+StatsReporter::StatsReporter(const Metrics& metrics, const BlockCache& cache, const StorageEngine& disk,
+                             const std::string& output_file, StatsFormat format, std::chrono::milliseconds interval)
+    : metrics(metrics)
+    , cache(cache)
+    , disk(disk)
+    , output_file(output_file)
+    , format(format)
+    , interval(interval)
+    , last_dump(takeSample())
+    , last_interval_start(last_dump) {
+}
+
+StatsReporter::~StatsReporter() {
+    stop();
+}
+
+void StatsReporter::start() {
+    if (worker.joinable()) {
+        return;
+    }
+    
+    {
+        std::lock_guard<std::mutex> lock(wake_mutex);
+        stopping = false;
+    }
+    worker = std::thread(&StatsReporter::run, this);
+}
+
+void StatsReporter::stop() {
+    if (!worker.joinable()) {
+        return;
+    }
+    
+    {
+        std::lock_guard<std::mutex> lock(wake_mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    worker.join();
+    
+    // Final dump so the file reflects the state at shutdown
+    dump(true);
+}
+
+void StatsReporter::run() {
+    std::unique_lock<std::mutex> lock(wake_mutex);
+    while (!wake.wait_for(lock, interval, [this] { return stopping; })) {
+        lock.unlock();
+        dumpNow();
+        lock.lock();
+    }
+}
+
+bool StatsReporter::dumpNow() {
+    return dump(false);
+}
+
+StatsReporter::Sample StatsReporter::takeSample() const {
+    Sample sample;
+    sample.metrics = metrics.getMetrics();
+    sample.cache = cache.getStats();
+    sample.phases = metrics.getPhaseTracer().getTotals();
+    sample.time = std::chrono::steady_clock::now();
+    return sample;
+}
+
+bool StatsReporter::dump(bool final_dump) {
+    std::lock_guard<std::mutex> lock(dump_mutex);
+    
+    Sample sample = takeSample();
+    const Sample& baseline = final_dump ? last_interval_start : last_dump;
+    
+    const MetricsData& current = sample.metrics;
+    const CacheStats& cache_stats = sample.cache;
+    const PhaseBreakdown& phases = sample.phases;
+    const MetricsData& previous_metrics = baseline.metrics;
+    const CacheStats& previous_cache = baseline.cache;
+    const PhaseBreakdown& previous_phases = baseline.phases;
+    size_t cached_blocks = cache.size();
+    size_t cache_capacity = cache.capacity();
+    size_t queue_depth = disk.getQueueDepth();
+    size_t allocated_blocks = disk.getAllocatedBlocks();
+    
+    double elapsed_s = std::chrono::duration<double>(sample.time - baseline.time).count();
+    size_t interval_reads = delta(readCount(current), readCount(previous_metrics));
+    size_t interval_writes = delta(current.total_writes, previous_metrics.total_writes);
+    size_t interval_hits = delta(cache_stats.hits, previous_cache.hits);
+    size_t interval_misses = delta(cache_stats.misses, previous_cache.misses);
+    
+    double reads_per_sec = elapsed_s > 0.0 ? interval_reads / elapsed_s : 0.0;
+    double writes_per_sec = elapsed_s > 0.0 ? interval_writes / elapsed_s : 0.0;
+    double interval_hit_ratio = ratio(interval_hits, interval_hits + interval_misses);
+    double occupancy = ratio(cached_blocks, cache_capacity);
+    size_t total_ops = readCount(current) + current.total_writes;
+    
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(3);
+    
+    if (format == StatsFormat::Json) {
+        auto timestamp_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+        
+        out << "{\n";
+        out << "  \"timestamp_ms\": " << timestamp_ms << ",\n";
+        out << "  \"interval_s\": " << elapsed_s << ",\n";
+        out << "  \"ops_total\": " << total_ops << ",\n";
+        out << "  \"ops_per_sec\": " << (reads_per_sec + writes_per_sec) << ",\n";
+        out << "  \"reads_per_sec\": " << reads_per_sec << ",\n";
+        out << "  \"writes_per_sec\": " << writes_per_sec << ",\n";
+        out << "  \"hit_ratio_pct\": " << interval_hit_ratio << ",\n";
+        out << "  \"hit_ratio_total_pct\": " << cache_stats.getHitRatio() << ",\n";
+        out << "  \"avg_latency_ms\": " << current.avg_latency_ms << ",\n";
+        out << "  \"queue_depth\": " << queue_depth << ",\n";
+        out << "  \"cache_blocks\": " << cached_blocks << ",\n";
+        out << "  \"cache_capacity\": " << cache_capacity << ",\n";
+        out << "  \"cache_occupancy_pct\": " << occupancy << ",\n";
+        out << "  \"disk_allocated_blocks\": " << allocated_blocks << ",\n";
+        out << "  \"phases\": {";
+        for (size_t i = 0; i < PhaseBreakdown::phase_count; ++i) {
+            out << (i == 0 ? "\n" : ",\n");
+            out << "    \"" << PhaseTracer::getPhaseName(static_cast<Phase>(i)) << "\": {"
+                << "\"total_ms\": " << phases.total_ms[i]
+                << ", \"samples\": " << phases.samples[i]
+                << ", \"interval_ms\": " << (phases.total_ms[i] - previous_phases.total_ms[i])
+                << "}";
+        }
+        out << "\n  }\n";
+        out << "}\n";
+    } else {
+        out << "# TYPE ministorage_ops_total counter\n";
+        out << "ministorage_ops_total " << total_ops << "\n";
+        out << "# TYPE ministorage_ops_per_second gauge\n";
+        out << "ministorage_ops_per_second{op=\"read\"} " << reads_per_sec << "\n";
+        out << "ministorage_ops_per_second{op=\"write\"} " << writes_per_sec << "\n";
+        out << "# TYPE ministorage_hit_ratio_percent gauge\n";
+        out << "ministorage_hit_ratio_percent{window=\"interval\"} " << interval_hit_ratio << "\n";
+        out << "ministorage_hit_ratio_percent{window=\"total\"} " << cache_stats.getHitRatio() << "\n";
+        out << "# TYPE ministorage_avg_latency_ms gauge\n";
+        out << "ministorage_avg_latency_ms " << current.avg_latency_ms << "\n";
+        out << "# TYPE ministorage_queue_depth gauge\n";
+        out << "ministorage_queue_depth " << queue_depth << "\n";
+        out << "# TYPE ministorage_cache_blocks gauge\n";
+        out << "ministorage_cache_blocks " << cached_blocks << "\n";
+        out << "# TYPE ministorage_cache_capacity_blocks gauge\n";
+        out << "ministorage_cache_capacity_blocks " << cache_capacity << "\n";
+        out << "# TYPE ministorage_cache_occupancy_percent gauge\n";
+        out << "ministorage_cache_occupancy_percent " << occupancy << "\n";
+        out << "# TYPE ministorage_disk_allocated_blocks gauge\n";
+        out << "ministorage_disk_allocated_blocks " << allocated_blocks << "\n";
+        out << "# TYPE ministorage_phase_ms_total counter\n";
+        for (size_t i = 0; i < PhaseBreakdown::phase_count; ++i) {
+            out << "ministorage_phase_ms_total{phase=\"" << PhaseTracer::getPhaseName(static_cast<Phase>(i))
+                << "\"} " << phases.total_ms[i] << "\n";
+        }
+        out << "# TYPE ministorage_phase_samples_total counter\n";
+        for (size_t i = 0; i < PhaseBreakdown::phase_count; ++i) {
+            out << "ministorage_phase_samples_total{phase=\"" << PhaseTracer::getPhaseName(static_cast<Phase>(i))
+                << "\"} " << phases.samples[i] << "\n";
+        }
+    }
+    
+    if (!final_dump) {
+        last_interval_start = last_dump;
+    }
+    last_dump = sample;
+    
+    std::string temp_name = output_file + ".tmp";
+    {
+        std::ofstream file(temp_name, std::ios::trunc);
+        if (!file.is_open()) {
+            return false;
+        }
+        file << out.str();
+        if (file.fail()) {
+            return false;
+        }
+    }
+    
+    std::error_code ec;
+    std::filesystem::rename(temp_name, output_file, ec);
+    return !ec;
+}
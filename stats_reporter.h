@@ -0,0 +1,60 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include "block_cache.h"
+#include "metrics.h"
+
+class StorageEngine;
+
+enum class StatsFormat {
+    Json,
+    Prometheus
+};
+
+// Periodically dumps current stats plus deltas since the previous dump to a file.
+// The file is replaced atomically, so readers never see a partial dump.
+class StatsReporter {
+private:
+    const Metrics& metrics;
+    const BlockCache& cache;
+    const StorageEngine& disk;
+    std::string output_file;
+    StatsFormat format;
+    std::chrono::milliseconds interval;
+    
+    std::thread worker;
+    std::mutex wake_mutex;
+    std::condition_variable wake;
+    bool stopping = false;
+    
+    struct Sample {
+        MetricsData metrics;
+        CacheStats cache;
+        PhaseBreakdown phases;
+        std::chrono::steady_clock::time_point time;
+    };
+    
+    // Interval deltas are taken against the previous dump. The final dump at
+    // shutdown folds its short tail into the last full interval instead.
+    std::mutex dump_mutex;
+    Sample last_dump;
+    Sample last_interval_start;
+
+public:
+    StatsReporter(const Metrics& metrics, const BlockCache& cache, const StorageEngine& disk,
+                  const std::string& output_file, StatsFormat format, std::chrono::milliseconds interval);
+    ~StatsReporter();
+    
+    void start();
+    void stop();
+    bool dumpNow();
+
+private:
+    void run();
+    Sample takeSample() const;
+    bool dump(bool final_dump);
+};
@@ -4,9 +4,26 @@
 #include <cstring>
 #include <thread>
 #include <chrono>
+#include <filesystem>
 #include <random>
 #include <vector>
 
+namespace {
+    // Counts a request against the queue depth for as long as it is in flight
+    class QueueSlot {
+    private:
+        std::atomic<size_t>& depth;
+    
+    public:
+        explicit QueueSlot(std::atomic<size_t>& depth) : depth(depth) {
+            depth.fetch_add(1, std::memory_order_relaxed);
+        }
+        ~QueueSlot() {
+            depth.fetch_sub(1, std::memory_order_relaxed);
+        }
+    };
+}
+
 StorageEngine::StorageEngine(const std::string& filename, size_t disk_size_mb, size_t block_size_bytes)
     : disk_file_name(filename)
     , disk_size_bytes(disk_size_mb * 1024 * 1024)
@@ -29,21 +46,28 @@ bool StorageEngine::setupDisk() {
     bool file_exists = check_file.good();
     check_file.close();
     
+    std::string bitmap_file_name = disk_file_name + ".bitmap";
+    
     if (!file_exists) {
         std::ofstream create_file(disk_file_name, std::ios::binary);
         if (!create_file.is_open()) {
             return false;
         }
+        create_file.close();
         
-        std::vector<char> empty_block(block_size_bytes, 0);
-        for (size_t i = 0; i < total_blocks; ++i) {
-            create_file.write(empty_block.data(), block_size_bytes);
-            if (create_file.fail()) {
-                return false;
-            }
+        // Unallocated blocks are never read, so the file can be extended sparsely
+        std::error_code ec;
+        std::filesystem::resize_file(disk_file_name, total_blocks * block_size_bytes, ec);
+        if (ec) {
+            return false;
         }
-        
-        create_file.close();
+    }
+    
+    // A new disk starts all free; an existing one keeps its bitmap, or is treated as fully in use
+    // when the bitmap is missing or unreadable
+    allocation_map = std::make_unique<AllocationBitmap>(bitmap_file_name, total_blocks);
+    if (!allocation_map->load(file_exists)) {
+        return false;
     }
     
     disk_file = std::make_unique<std::fstream>(disk_file_name, std::ios::in | std::ios::out | std::ios::binary);
@@ -59,45 +83,216 @@ bool StorageEngine::readBlock(int block_number, char* buffer) {
         return false;
     }
     
+    QueueSlot slot(queue_depth);
+    auto lock = lockIo();
+    
+    if (!allocation_map->isAllocated(static_cast<size_t>(block_number))) {
+        PhaseTracer::Scope copy_phase(phase_tracer, Phase::Copy);
+        std::memset(buffer, 0, block_size_bytes);
+        return true;
+    }
+    
     addLatency();
     
+    {
+        PhaseTracer::Scope io_phase(phase_tracer, Phase::IoSyscall);
+        std::streampos position = static_cast<std::streampos>(block_number * block_size_bytes);
+        disk_file->seekg(position);
+        
+        if (disk_file->fail()) {
+            return false;
+        }
+        
+        disk_file->read(buffer, block_size_bytes);
+        if (disk_file->fail() && !disk_file->eof()) {
+            return false;
+        }
+    }
+    
+    PhaseTracer::Scope copy_phase(phase_tracer, Phase::Copy);
+    buffer[block_size_bytes - 1] = '\0';
+    
+    return true;
+}
+
+bool StorageEngine::writeBlock(int block_number, const char* data) {
+    if (!isValidBlock(block_number)) {
+        return false;
+    }
+    
+    std::vector<char> buffer(block_size_bytes, 0);
+    {
+        PhaseTracer::Scope copy_phase(phase_tracer, Phase::Copy);
+        size_t data_len = std::strlen(data);
+        size_t copy_len = std::min(data_len, block_size_bytes - 1);
+        std::memcpy(buffer.data(), data, copy_len);
+    }
+    
+    QueueSlot slot(queue_depth);
+    auto lock = lockIo();
+    
+    addLatency();
+    
+    PhaseTracer::Scope io_phase(phase_tracer, Phase::IoSyscall);
     std::streampos position = static_cast<std::streampos>(block_number * block_size_bytes);
-    disk_file->seekg(position);
+    disk_file->seekp(position);
     
     if (disk_file->fail()) {
         return false;
     }
     
-    disk_file->read(buffer, block_size_bytes);
-    if (disk_file->fail() && !disk_file->eof()) {
+    disk_file->write(buffer.data(), block_size_bytes);
+    if (disk_file->fail()) {
         return false;
     }
     
-    buffer[block_size_bytes - 1] = '\0';
+    disk_file->flush();
+    
+    if (!allocation_map->isAllocated(static_cast<size_t>(block_number))) {
+        return allocation_map->markAllocated(static_cast<size_t>(block_number), 1);
+    }
     
     return true;
 }
 
-bool StorageEngine::writeBlock(int block_number, const char* data) {
-    if (!isValidBlock(block_number)) {
+bool StorageEngine::readBlocks(int first_block, size_t count, char* buffer) {
+    if (count == 0) {
+        return true;
+    }
+    if (!isValidRange(first_block, count)) {
         return false;
     }
     
+    QueueSlot slot(queue_depth);
+    auto lock = lockIo();
+    
+    size_t first = static_cast<size_t>(first_block);
+    if (!allocation_map->anyAllocated(first, count)) {
+        PhaseTracer::Scope copy_phase(phase_tracer, Phase::Copy);
+        std::memset(buffer, 0, count * block_size_bytes);
+        return true;
+    }
+    
     addLatency();
     
-    std::streampos position = static_cast<std::streampos>(block_number * block_size_bytes);
+    {
+        PhaseTracer::Scope io_phase(phase_tracer, Phase::IoSyscall);
+        std::streampos position = static_cast<std::streampos>(first_block * block_size_bytes);
+        disk_file->seekg(position);
+        
+        if (disk_file->fail()) {
+            return false;
+        }
+        
+        disk_file->read(buffer, count * block_size_bytes);
+        if (disk_file->fail() && !disk_file->eof()) {
+            return false;
+        }
+    }
+    
+    PhaseTracer::Scope copy_phase(phase_tracer, Phase::Copy);
+    for (size_t i = 0; i < count; ++i) {
+        char* block_buffer = buffer + i * block_size_bytes;
+        if (allocation_map->isAllocated(first + i)) {
+            block_buffer[block_size_bytes - 1] = '\0';
+        } else {
+            // Freed but not trimmed blocks may still hold stale bytes on disk
+            std::memset(block_buffer, 0, block_size_bytes);
+        }
+    }
+    
+    return true;
+}
+
+bool StorageEngine::writeBlocks(int first_block, size_t count, const char* data) {
+    if (count == 0) {
+        return true;
+    }
+    if (!isValidRange(first_block, count)) {
+        return false;
+    }
+    
+    QueueSlot slot(queue_depth);
+    auto lock = lockIo();
+    
+    addLatency();
+    
+    PhaseTracer::Scope io_phase(phase_tracer, Phase::IoSyscall);
+    std::streampos position = static_cast<std::streampos>(first_block * block_size_bytes);
     disk_file->seekp(position);
     
     if (disk_file->fail()) {
         return false;
     }
     
-    std::vector<char> buffer(block_size_bytes, 0);
-    size_t data_len = std::strlen(data);
-    size_t copy_len = std::min(data_len, block_size_bytes - 1);
-    std::memcpy(buffer.data(), data, copy_len);
+    disk_file->write(data, count * block_size_bytes);
+    if (disk_file->fail()) {
+        return false;
+    }
     
-    disk_file->write(buffer.data(), block_size_bytes);
+    disk_file->flush();
+    
+    return allocation_map->markAllocated(static_cast<size_t>(first_block), count);
+}
+
+int StorageEngine::allocate(size_t count) {
+    QueueSlot slot(queue_depth);
+    auto lock = lockIo();
+    
+    int first_block = allocation_map->allocate(count);
+    if (first_block < 0) {
+        return -1;
+    }
+    
+    // The extent may hold stale bytes from an earlier free; hand it out zeroed
+    if (!zeroBlocks(first_block, count)) {
+        allocation_map->markFree(static_cast<size_t>(first_block), count);
+        return -1;
+    }
+    
+    return first_block;
+}
+
+bool StorageEngine::free(int first_block, size_t count) {
+    if (!isValidRange(first_block, count)) {
+        return false;
+    }
+    
+    QueueSlot slot(queue_depth);
+    auto lock = lockIo();
+    
+    return allocation_map->markFree(static_cast<size_t>(first_block), count);
+}
+
+bool StorageEngine::trim(int first_block, size_t count) {
+    if (!isValidRange(first_block, count)) {
+        return false;
+    }
+    
+    QueueSlot slot(queue_depth);
+    auto lock = lockIo();
+    
+    if (!zeroBlocks(first_block, count)) {
+        return false;
+    }
+    
+    return allocation_map->markFree(static_cast<size_t>(first_block), count);
+}
+
+// Caller holds io_lock
+bool StorageEngine::zeroBlocks(int first_block, size_t count) {
+    addLatency();
+    
+    PhaseTracer::Scope io_phase(phase_tracer, Phase::IoSyscall);
+    std::streampos position = static_cast<std::streampos>(first_block * block_size_bytes);
+    disk_file->seekp(position);
+    
+    if (disk_file->fail()) {
+        return false;
+    }
+    
+    std::vector<char> zeros(count * block_size_bytes, 0);
+    disk_file->write(zeros.data(), zeros.size());
     if (disk_file->fail()) {
         return false;
     }
@@ -111,7 +306,38 @@ bool StorageEngine::isValidBlock(int block_number) const {
     return block_number >= 0 && static_cast<size_t>(block_number) < total_blocks;
 }
 
+bool StorageEngine::isValidRange(int first_block, size_t count) const {
+    return count > 0 && isValidBlock(first_block)
+        && count <= total_blocks - static_cast<size_t>(first_block);
+}
+
+size_t StorageEngine::getAllocatedBlocks() const {
+    std::lock_guard<std::mutex> lock(io_lock);
+    return allocation_map->getAllocatedBlocks();
+}
+
+size_t StorageEngine::getFreeBlocks() const {
+    std::lock_guard<std::mutex> lock(io_lock);
+    return allocation_map->getFreeBlocks();
+}
+
+bool StorageEngine::isAllocated(int block_number) const {
+    if (!isValidBlock(block_number)) {
+        return false;
+    }
+    
+    std::lock_guard<std::mutex> lock(io_lock);
+    return allocation_map->isAllocated(static_cast<size_t>(block_number));
+}
+
+std::unique_lock<std::mutex> StorageEngine::lockIo() const {
+    PhaseTracer::Scope wait_phase(phase_tracer, Phase::LockWait);
+    return std::unique_lock<std::mutex>(io_lock);
+}
+
 void StorageEngine::addLatency() const {
+    PhaseTracer::Scope latency_phase(phase_tracer, Phase::DeviceLatency);
+    
     std::random_device rd;
     std::mt19937 gen(rd());
     std::uniform_int_distribution<> dis(1, 5);
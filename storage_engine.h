@@ -3,6 +3,10 @@
 #include <string>
 #include <fstream>
 #include <memory>
+#include <mutex>
+#include <atomic>
+#include "allocation_bitmap.h"
+#include "metrics.h"
 
 class StorageEngine {
 private:
@@ -11,20 +15,49 @@ private:
     size_t block_size_bytes;
     size_t total_blocks;
     std::unique_ptr<std::fstream> disk_file;
+    std::unique_ptr<AllocationBitmap> allocation_map;
+    mutable std::mutex io_lock;
+    std::atomic<size_t> queue_depth{0};  // Requests waiting for or holding io_lock
+    PhaseTracer* phase_tracer = nullptr;
     
+    std::unique_lock<std::mutex> lockIo() const;
     void addLatency() const;
+    bool zeroBlocks(int first_block, size_t count);
+    bool isValidRange(int first_block, size_t count) const;
 
 public:
     StorageEngine(const std::string& filename, size_t disk_size_mb, size_t block_size_bytes);
     ~StorageEngine();
     
+    // Reads of unallocated blocks return zeros without touching the disk.
+    // Writes allocate the target block if needed.
     bool readBlock(int block_number, char* buffer);
     bool writeBlock(int block_number, const char* data);
     
+    // Sequential read/write of a contiguous run of blocks with a single latency charge.
+    // buffer/data must hold count * block size bytes.
+    bool readBlocks(int first_block, size_t count, char* buffer);
+    bool writeBlocks(int first_block, size_t count, const char* data);
+    
+    // Free-space management. allocate returns the first block of a contiguous,
+    // zero-filled extent or -1. free only releases an extent in the bitmap; its old
+    // bytes stay on disk until the blocks are reallocated (which zeroes them) or trimmed.
+    // trim zeroes the extent and releases it.
+    int allocate(size_t count);
+    bool free(int first_block, size_t count);
+    bool trim(int first_block, size_t count);
+    
     bool setupDisk();
     size_t getTotalBlocks() const { return total_blocks; }
     size_t getBlockSize() const { return block_size_bytes; }
     size_t getDiskSize() const { return disk_size_bytes; }
+    size_t getAllocatedBlocks() const;
+    size_t getFreeBlocks() const;
+    size_t getQueueDepth() const { return queue_depth.load(std::memory_order_relaxed); }
+    
+    // Lock wait, device latency, I/O and copy phases are timed into the tracer when it is enabled
+    void setPhaseTracer(PhaseTracer* tracer) { phase_tracer = tracer; }
     
     bool isValidBlock(int block_number) const;
+    bool isAllocated(int block_number) const;
 };